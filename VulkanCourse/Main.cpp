@@ -1,6 +1,12 @@
 // std
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
 // glfw
@@ -9,48 +15,128 @@
 
 // src
 #include "Public/VulkanRenderer.h"
+#include "Public/VulkanWindow.h"
 
-// TODO: Anonymous Namespace will be then refactor into a VulkanWindow class and a VulkanApp class for clarity later
+// TODO: Anonymous Namespace will be then refactor into a VulkanApp class for clarity later
 namespace
 {
-    GLFWwindow* window;
+    VulkanWindow vkWindow;
     VulkanRenderer vkRenderer;
 
-    static void initWindow(const std::string& w_name = "Vulkan Course", const int width = 800, const int height = 600)
+    std::atomic<bool> stopRenderThread { false };
+
+    /// Command line: [--capture <path>] [--capture-format raw|y4m|ppm] [--frame-budget <ms, 0 disables dynamic resolution>]
+    static bool parseCommandLine(const int argc, char* argv[], CaptureSettings& captureSettings, DynamicResolutionSettings& resolutionSettings)
     {
-        glfwInit();
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+
+            if (argument == "--capture" && i + 1 < argc)
+            {
+                captureSettings.enabled = true;
+                captureSettings.path = argv[++i];
+            }
+            else if (argument == "--capture-format" && i + 1 < argc)
+            {
+                const std::string format = argv[++i];
+
+                if (format == "raw")
+                    captureSettings.format = CAPTURE_FORMAT_RAW;
+                else if (format == "y4m")
+                    captureSettings.format = CAPTURE_FORMAT_Y4M;
+                else if (format == "ppm")
+                    captureSettings.format = CAPTURE_FORMAT_PPM;
+                else
+                {
+                    std::cout << "ERROR:" << "unknown capture format " << format << '\n';
+                    return false;
+                }
+            }
+            else if (argument == "--frame-budget" && i + 1 < argc)
+            {
+                const char* value = argv[++i];
+                char* valueEnd = nullptr;
+                const double frameBudgetMs = std::strtod(value, &valueEnd);
+
+                if (valueEnd == value || *valueEnd != '\0' || !std::isfinite(frameBudgetMs) || frameBudgetMs < 0.0)
+                {
+                    std::cout << "ERROR:" << "invalid frame budget " << value << '\n';
+                    return false;
+                }
 
-        // Set glfw to not work with another graphic API other than Vulkan
-        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-        glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+                resolutionSettings.enabled = frameBudgetMs > 0.0;
+                if (resolutionSettings.enabled)
+                    resolutionSettings.targetFrameTimeMs = frameBudgetMs;
+            }
+            else
+            {
+                std::cout << "ERROR:" << "unknown argument " << argument << '\n';
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /// Render thread: draws frames until the main thread asks it to stop.
+    /// Window events come in through the window event queue, GLFW itself is never called from here.
+    static void renderLoop()
+    {
+        try
+        {
+            while (!stopRenderThread.load(std::memory_order_acquire))
+            {
+                // Nothing presented (e.g. minimised), don't spin at full speed
+                if (!vkRenderer.draw(vkWindow.getEventQueue()))
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        } catch (const std::runtime_error &e)
+        {
+            std::cout << "ERROR:" << e.what() << '\n';
 
-        window = glfwCreateWindow(width, height, w_name.c_str(), nullptr, nullptr);
+            // Bring down the window thread too
+            vkWindow.requestClose();
+        }
     }
 
     static void shutdownApplication()
     {
         vkRenderer.cleanup();
-
-        // Destroy GLFW Window and stop GLFW
-        glfwDestroyWindow(window);
-        glfwTerminate();
+        vkWindow.cleanup();
     }
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+    CaptureSettings captureSettings;
+    DynamicResolutionSettings resolutionSettings;
+    if (!parseCommandLine(argc, argv, captureSettings, resolutionSettings))
+        return EXIT_FAILURE;
+
     // Create our window
-    initWindow();
+    if (vkWindow.init() == EXIT_FAILURE)
+        return EXIT_FAILURE;
 
     // Create Renderer instance
-    if (vkRenderer.init(window) == EXIT_FAILURE)
+    if (vkRenderer.init(vkWindow.getWindow(), captureSettings, resolutionSettings) == EXIT_FAILURE)
+    {
+        vkWindow.cleanup();
         return EXIT_FAILURE;
+    }
 
-    while (!glfwWindowShouldClose(window))
+    // Rendering runs on its own thread so window stalls (drag, minimise...) and slow frames don't block each other
+    std::thread renderThread(renderLoop);
+
+    // Main thread only processes window events
+    while (!vkWindow.shouldClose())
     {
-        glfwPollEvents();
+        vkWindow.waitEvents();
     }
 
+    stopRenderThread.store(true, std::memory_order_release);
+    renderThread.join();
+
     shutdownApplication();
 
     return 0;
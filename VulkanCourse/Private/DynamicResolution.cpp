@@ -0,0 +1,61 @@
+#include "../Public/DynamicResolution.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr double smoothingFactor = 0.1;     // Weight of the newest sample in the moving average
+    constexpr double lowUsage = 0.85;           // Below this part of the budget, scale up. Above the budget, scale down
+    constexpr double aimedUsage = 0.925;        // Part of the budget aimed for when changing the scale
+    constexpr float maxScaleStep = 0.05f;       // Biggest scale change per update
+    constexpr int settleFrames = 8;             // Frames measured at a new scale before changing it again
+}
+
+void DynamicResolutionController::init(const DynamicResolutionSettings& new_settings)
+{
+    settings = new_settings;
+    scale = settings.maxScale;
+    hasSample = false;
+    framesSinceChange = 0;
+}
+
+float DynamicResolutionController::update(const double gpuFrameTimeMs)
+{
+    if (!settings.enabled)
+        return scale;
+
+    // Smooth out single frame spikes
+    smoothedFrameTimeMs = hasSample ? smoothedFrameTimeMs + smoothingFactor * (gpuFrameTimeMs - smoothedFrameTimeMs) : gpuFrameTimeMs;
+    hasSample = true;
+
+    // Frames still in flight were rendered at the previous scale, wait for the measurements to catch up.
+    // Stops counting once settled, so holding a scale for a long time never overflows it
+    if (framesSinceChange < settleFrames)
+    {
+        ++framesSinceChange;
+        return scale;
+    }
+
+    // Dead band between lowUsage and the budget, so the scale settles instead of oscillating
+    const double usage = smoothedFrameTimeMs / settings.targetFrameTimeMs;
+    if (usage >= lowUsage && usage <= 1.0)
+        return scale;
+
+    // GPU time grows roughly with the pixel count, i.e. with the scale squared
+    float newScale = scale * static_cast<float>(std::sqrt(aimedUsage / usage));
+    newScale = std::max(scale - maxScaleStep, std::min(scale + maxScaleStep, newScale));
+    newScale = std::max(settings.minScale, std::min(settings.maxScale, newScale));
+
+    if (newScale != scale)
+    {
+        scale = newScale;
+
+        // Restart the average from measurements at the new scale
+        hasSample = false;
+        framesSinceChange = 0;
+    }
+
+    return scale;
+}
@@ -0,0 +1,240 @@
+#include "../Public/FrameCapture.h"
+
+// std
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+
+FrameCapture::~FrameCapture()
+{
+    // A std::thread still joinable on destruction terminates the program
+    stop();
+}
+
+void FrameCapture::start(const CaptureSettings& new_settings, const uint32_t new_width, const uint32_t new_height, const bool new_bgra)
+{
+    settings = new_settings;
+    width = new_width;
+    height = new_height;
+    bgra = new_bgra;
+
+    // RGBA frames already in the right layout are written straight from the readback memory
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    conversionBuffer.resize(pixelCount * bytesPerPixel);
+
+    // PPM opens one file per frame, others stream to a single file
+    if (settings.format != CAPTURE_FORMAT_PPM)
+    {
+        file.open(settings.path, std::ios::binary | std::ios::trunc);
+
+        if (!file.is_open())
+            throw std::runtime_error("failed to open capture file!");
+    }
+
+    if (settings.format == CAPTURE_FORMAT_Y4M)
+    {
+        // Frame rate is only metadata here, frames are captured at whatever rate they are rendered
+        file << "YUV4MPEG2 W" << width << " H" << height << " F60:1 Ip A1:1 C444\n";
+    }
+
+    stopWriter.store(false, std::memory_order_relaxed);
+    writerThread = std::thread(&FrameCapture::writerLoop, this);
+}
+
+void FrameCapture::stop()
+{
+    if (!writerThread.joinable())
+        return;
+
+    // Writer drains the pending frames before leaving
+    stopWriter.store(true, std::memory_order_release);
+    writerThread.join();
+
+    if (file.is_open())
+    {
+        // Buffered data is only written here, a failure loses the tail of the stream
+        file.close();
+        if (!file)
+            std::cout << "ERROR:" << "failed to flush capture file " << settings.path << '\n';
+    }
+
+    const double seconds = std::chrono::duration<double>(writeTime).count();
+    const double megabytes = static_cast<double>(writtenByteCount) / (1024.0 * 1024.0);
+
+    std::cout << "Capture: " << writtenFrameCount << " frames (" << width << "x" << height << "), "
+              << megabytes << " MB written in " << seconds << " s";
+
+    if (seconds > 0.0)
+        std::cout << " (" << megabytes / seconds << " MB/s, " << writtenFrameCount / seconds << " frames/s)";
+
+    std::cout << ", " << droppedFrameCount << " frames dropped, " << failedFrameCount << " frames failed to write" << '\n';
+}
+
+bool FrameCapture::submitFrame(const CapturedFrame& frame)
+{
+    return pendingFrames.push(frame);
+}
+
+bool FrameCapture::popReleasedSlot(uint32_t& slot)
+{
+    return releasedSlots.pop(slot);
+}
+
+void FrameCapture::writerLoop()
+{
+    CapturedFrame frame;
+
+    while (true)
+    {
+        // Read the flag before popping: once it is set, an empty queue means no frame will ever come in
+        const bool stopping = stopWriter.load(std::memory_order_acquire);
+
+        if (pendingFrames.pop(frame))
+        {
+            writeFrame(frame);
+
+            // Readback ring is never bigger than this queue, the push cannot fail
+            releasedSlots.push(frame.slot);
+            continue;
+        }
+
+        if (stopping)
+            break;
+
+        // Nothing to write, at most one frame every few ms comes in
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void FrameCapture::writeFrame(const CapturedFrame& frame)
+{
+    const auto writeStart = std::chrono::steady_clock::now();
+
+    bool written = false;
+    switch (settings.format)
+    {
+    case CAPTURE_FORMAT_RAW:
+        written = writeRaw(frame.data);
+        break;
+    case CAPTURE_FORMAT_Y4M:
+        written = writeY4m(frame.data);
+        break;
+    case CAPTURE_FORMAT_PPM:
+        written = writePpm(frame.data, frame.frameNumber);
+        break;
+    }
+
+    writeTime += std::chrono::steady_clock::now() - writeStart;
+
+    if (written)
+    {
+        ++writtenFrameCount;
+        return;
+    }
+
+    // Report the first failure only, a full disk would otherwise print once per frame
+    if (failedFrameCount == 0)
+        std::cout << "ERROR:" << "failed to write captured frame " << frame.frameNumber << '\n';
+
+    ++failedFrameCount;
+}
+bool FrameCapture::writeRaw(const uint8_t* pixels)
+{
+    const size_t frameSize = static_cast<size_t>(width) * height * bytesPerPixel;
+    const uint8_t* output = pixels;
+
+    // Raw output is always RGBA, swap red and blue for BGRA swapchains
+    if (bgra)
+    {
+        for (size_t i = 0; i < frameSize; i += bytesPerPixel)
+        {
+            conversionBuffer[i + 0] = pixels[i + 2];
+            conversionBuffer[i + 1] = pixels[i + 1];
+            conversionBuffer[i + 2] = pixels[i + 0];
+            conversionBuffer[i + 3] = pixels[i + 3];
+        }
+
+        output = conversionBuffer.data();
+    }
+
+    file.write(reinterpret_cast<const char*>(output), static_cast<std::streamsize>(frameSize));
+    if (!file)
+        return false;
+
+    writtenByteCount += frameSize;
+    return true;
+}
+
+bool FrameCapture::writeY4m(const uint8_t* pixels)
+{
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+
+    // Planar output: Y plane, then U plane, then V plane (no chroma subsampling with C444)
+    uint8_t* yPlane = conversionBuffer.data();
+    uint8_t* uPlane = yPlane + pixelCount;
+    uint8_t* vPlane = uPlane + pixelCount;
+
+    const int redOffset = bgra ? 2 : 0;
+    const int blueOffset = bgra ? 0 : 2;
+
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        const int r = pixels[i * bytesPerPixel + redOffset];
+        const int g = pixels[i * bytesPerPixel + 1];
+        const int b = pixels[i * bytesPerPixel + blueOffset];
+
+        // BT.601 limited range, integer approximation
+        yPlane[i] = static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        uPlane[i] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        vPlane[i] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+
+    const size_t frameSize = pixelCount * 3;
+
+    file << "FRAME\n";
+    file.write(reinterpret_cast<const char*>(conversionBuffer.data()), static_cast<std::streamsize>(frameSize));
+    if (!file)
+        return false;
+
+    writtenByteCount += frameSize;
+    return true;
+}
+
+bool FrameCapture::writePpm(const uint8_t* pixels, const uint64_t frameNumber)
+{
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+
+    const int redOffset = bgra ? 2 : 0;
+    const int blueOffset = bgra ? 0 : 2;
+
+    // PPM has no alpha: pack to RGB
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        conversionBuffer[i * 3 + 0] = pixels[i * bytesPerPixel + redOffset];
+        conversionBuffer[i * 3 + 1] = pixels[i * bytesPerPixel + 1];
+        conversionBuffer[i * 3 + 2] = pixels[i * bytesPerPixel + blueOffset];
+    }
+
+    // e.g. capture_000042.ppm
+    std::ostringstream fileName;
+    fileName << settings.path << '_' << std::setw(6) << std::setfill('0') << frameNumber << ".ppm";
+
+    std::ofstream frameFile(fileName.str(), std::ios::binary | std::ios::trunc);
+
+    if (!frameFile.is_open())
+        return false;
+
+    frameFile << "P6\n" << width << ' ' << height << "\n255\n";
+
+    const size_t frameSize = pixelCount * 3;
+    frameFile.write(reinterpret_cast<const char*>(conversionBuffer.data()), static_cast<std::streamsize>(frameSize));
+
+    // Flush now so a failed write is seen here and not lost in the destructor
+    frameFile.close();
+    if (!frameFile)
+        return false;
+
+    writtenByteCount += frameSize;
+    return true;
+}
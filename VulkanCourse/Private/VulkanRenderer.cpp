@@ -1,8 +1,10 @@
 #include "../Public/VulkanRenderer.h"
 
-int VulkanRenderer::init(GLFWwindow* new_window)
+int VulkanRenderer::init(GLFWwindow* new_window, const CaptureSettings& new_captureSettings, const DynamicResolutionSettings& new_resolutionSettings)
 {
     window = new_window;
+    captureSettings = new_captureSettings;
+    resolutionController.init(new_resolutionSettings);
 
     try
     {
@@ -11,7 +13,19 @@ int VulkanRenderer::init(GLFWwindow* new_window)
         getPhysicalDevice();
         createLogicalDevice();
         createSwapchain();
+        createRenderTarget();
+        createRenderPass();
         createGraphicsPipeline();
+        createFramebuffers();
+        createCommandPool();
+        createCommandBuffers();
+        createSynchronisation();
+        createCaptureResources();
+        createTimestampQueryPool();
+
+        // Writer thread started last: a failing init step never leaves it running
+        if (captureSettings.enabled)
+            frameCapture.start(captureSettings, swapchainExtent.width, swapchainExtent.height, swapchainImageFormat == VK_FORMAT_B8G8R8A8_UNORM);
     } catch (const std::runtime_error &e)
     {
         std::cout << "ERROR:" << e.what() << '\n';
@@ -21,8 +35,150 @@ int VulkanRenderer::init(GLFWwindow* new_window)
     return 0;
 }
 
-void VulkanRenderer::cleanup() const
+/// Render and present one frame. Called from the render thread.
+/// Returns false if nothing was presented (e.g. window minimised), so the caller can avoid spinning.
+bool VulkanRenderer::draw(WindowEventQueue& events)
 {
+    // -- WAIT FOR FRAME SLOT --
+    // The command buffer and semaphores of this slot are free once the GPU reached the value of their last submission
+    waitForTimelinePoint(frameTimelinePoints[currentFrame]);
+    collectCapturedFrames();
+
+    // Timestamps of this slot's last frame are available now that the GPU reached it
+    updateRenderExtent();
+
+    // Nothing can be presented to a minimised window
+    processWindowEvents(events);
+    if (windowMinimised)
+    {
+        frameEventCount = 0;
+        return false;
+    }
+
+    // -- GET NEXT IMAGE --
+    // Acquire can only signal a binary semaphore.
+    // Finite timeout: the image may never come back (e.g. minimised in between), the render thread must still see its stop request
+    constexpr uint64_t acquireTimeoutNs = 100000000;    // 100 ms
+
+    uint32_t imageIndex;
+    const VkResult acquireResult = vkAcquireNextImageKHR(mainDevice.logicalDevice, swapchain, acquireTimeoutNs, imageAvailable[currentFrame], VK_NULL_HANDLE, &imageIndex);
+
+    // Out of date (e.g. 0x0 surface when minimised) or no image in time: no image and the semaphore is not signaled, skip the frame
+    if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR || acquireResult == VK_TIMEOUT || acquireResult == VK_NOT_READY)
+    {
+        frameEventCount = 0;
+        return false;
+    }
+
+    // Suboptimal still gives a usable image, handled like present does
+    if (acquireResult != VK_SUCCESS && acquireResult != VK_SUBOPTIMAL_KHR)
+        throw std::runtime_error("failed to acquire a Swapchain image!");
+
+    // Acquire may have blocked: sample the events again as late as possible before recording
+    processWindowEvents(events);
+
+    // -- RECORD --
+    // Pick the readback slot for this frame. If the writer is behind, drop the capture rather than waiting
+    int captureSlot = -1;
+    if (captureSettings.enabled)
+    {
+        if (captureSlots[nextCaptureSlot].state == CAPTURE_SLOT_FREE)
+        {
+            captureSlot = static_cast<int>(nextCaptureSlot);
+            nextCaptureSlot = (nextCaptureSlot + 1) % CAPTURE_RING_SIZE;
+        }
+        else
+            frameCapture.countDroppedFrame();
+    }
+
+    recordCommands(imageIndex, captureSlot);
+    frameTimestampsWritten[currentFrame] = timestampQueryPool != VK_NULL_HANDLE;
+
+    // -- SUBMIT --
+    BinarySemaphoreLink swapchainLink = {};
+    swapchainLink.waitSemaphore = imageAvailable[currentFrame];     // Wait for the image to be available before writing to it
+    swapchainLink.waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;       // Only the upscale blit writes it, the scene runs while waiting
+    swapchainLink.signalSemaphore = renderFinished[imageIndex];     // Present waits on this one
+
+    frameTimelinePoints[currentFrame] = submitToQueue(QUEUE_TIMELINE_GRAPHICS, commandBuffers[currentFrame], {}, swapchainLink);
+
+    // Readback buffer is collected a few frames later, once the GPU reached this submission
+    if (captureSlot >= 0)
+    {
+        captureSlots[captureSlot].state = CAPTURE_SLOT_IN_FLIGHT;
+        captureSlots[captureSlot].lastUse = frameTimelinePoints[currentFrame];
+        captureSlots[captureSlot].frameNumber = frameNumber;
+    }
+
+    // -- PRESENT --
+    VkPresentInfoKHR presentInfo = {};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.waitSemaphoreCount = 1;                             // Number of semaphores to wait on
+    presentInfo.pWaitSemaphores = &renderFinished[imageIndex];      // Semaphores to wait on
+    presentInfo.swapchainCount = 1;                                 // Number of swapchains to present to
+    presentInfo.pSwapchains = &swapchain;                           // Swapchains to present images to
+    presentInfo.pImageIndices = &imageIndex;                        // Index of images in swapchains to present
+
+    // Suboptimal still presents the image, the swapchain will just not match the surface exactly
+    const VkResult presentResult = vkQueuePresentKHR(presentQueue, &presentInfo);
+    if (presentResult != VK_SUCCESS && presentResult != VK_SUBOPTIMAL_KHR)
+        throw std::runtime_error("failed to present image!");
+
+    reportInputLatency(std::chrono::steady_clock::now());
+
+    // Get next frame (use % MAX_FRAME_DRAWS to keep value below MAX_FRAME_DRAWS)
+    currentFrame = (currentFrame + 1) % MAX_FRAME_DRAWS;
+    ++frameNumber;
+
+    return true;
+}
+
+void VulkanRenderer::cleanup()
+{
+    // Wait until no actions being run on device before destroying
+    vkDeviceWaitIdle(mainDevice.logicalDevice);
+
+    if (captureSettings.enabled)
+    {
+        // GPU is idle: every copy is complete, hand the remaining frames to the writer and let it finish
+        collectCapturedFrames();
+        frameCapture.stop();
+
+        for (const auto &slot : captureSlots)
+        {
+            vkUnmapMemory(mainDevice.logicalDevice, slot.memory);
+            vkDestroyBuffer(mainDevice.logicalDevice, slot.buffer, nullptr);
+            vkFreeMemory(mainDevice.logicalDevice, slot.memory, nullptr);
+        }
+    }
+
+    for (const auto semaphore : renderFinished)
+        vkDestroySemaphore(mainDevice.logicalDevice, semaphore, nullptr);
+
+    for (const auto semaphore : imageAvailable)
+        vkDestroySemaphore(mainDevice.logicalDevice, semaphore, nullptr);
+
+    for (const auto &timeline : queueTimelines)
+        vkDestroySemaphore(mainDevice.logicalDevice, timeline.semaphore, nullptr);
+
+    if (timestampQueryPool != VK_NULL_HANDLE)
+        vkDestroyQueryPool(mainDevice.logicalDevice, timestampQueryPool, nullptr);
+
+    // Command buffers are freed with their pool
+    vkDestroyCommandPool(mainDevice.logicalDevice, graphicsCommandPool, nullptr);
+
+    for (const auto framebuffer : renderTargetFramebuffers)
+        vkDestroyFramebuffer(mainDevice.logicalDevice, framebuffer, nullptr);
+
+    vkDestroyRenderPass(mainDevice.logicalDevice, renderPass, nullptr);
+
+    for (const auto &renderTarget : renderTargets)
+    {
+        vkDestroyImageView(mainDevice.logicalDevice, renderTarget.imageView, nullptr);
+        vkDestroyImage(mainDevice.logicalDevice, renderTarget.image, nullptr);
+        vkFreeMemory(mainDevice.logicalDevice, renderTarget.memory, nullptr);
+    }
+
     // Destroy all the created image views
     for (const auto image : swapchainImages)
         vkDestroyImageView(mainDevice.logicalDevice, image.imageView, nullptr);
@@ -95,10 +251,16 @@ void VulkanRenderer::createLogicalDevice()
 
     // Physical device features the Logical Device will be using
     VkPhysicalDeviceFeatures deviceFeatures = {};
+
+    // Vulkan 1.2 features, chained to the device creation. Timeline semaphores drive all the submissions
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
     
     // Creation information for the logical device
     VkDeviceCreateInfo deviceCreateInfo = {};
     deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceCreateInfo.pNext = &vulkan12Features;
     deviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
     deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());        // Number of enabled logical device extensions
@@ -114,6 +276,8 @@ void VulkanRenderer::createLogicalDevice()
     // Given logical device of given queue family of given queue index (here 0) place reference in given graphics queue handle
     vkGetDeviceQueue(mainDevice.logicalDevice, indices.graphicsFamily, 0, &graphicsQueue);
     vkGetDeviceQueue(mainDevice.logicalDevice, indices.presentFamily, 0, &presentQueue);
+
+    queueTimelines[QUEUE_TIMELINE_GRAPHICS].queue = graphicsQueue;
 }
 
 void VulkanRenderer::createSurface()
@@ -151,7 +315,8 @@ void VulkanRenderer::createSwapchain()
     swapchainCreateInfo.imageColorSpace = surfaceFormat.colorSpace;                             // Color Space
     swapchainCreateInfo.imageExtent = extent;                                                   // Extent
     swapchainCreateInfo.imageArrayLayers = 1;                                                   // Number of layers for each image in chain
-    swapchainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;                       // What attachment images will be used as
+    swapchainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT                        // What attachment images will be used as
+                                   | VK_IMAGE_USAGE_TRANSFER_DST_BIT;                           // Render target is upscaled into it with a blit
     swapchainCreateInfo.preTransform = swapchainSupport.surfaceCapabilities.currentTransform;   // Transform to perform on swapchain
     swapchainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;                     // How to handle blending images with external graphics (e.g. windows ...)
     swapchainCreateInfo.presentMode = presentMode;                                              // Presentation Mode
@@ -182,6 +347,19 @@ void VulkanRenderer::createSwapchain()
     // This is null for now, but when we resize the window we destroy the old swapchain and pass the old to the new
     swapchainCreateInfo.oldSwapchain = VK_NULL_HANDLE;
 
+    // Render target is upscaled into the swapchain images with a blit
+    if (!(swapchainSupport.surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT))
+        throw std::runtime_error("Swapchain images cannot be blitted to, render target cannot be upscaled on this surface!");
+
+    // Captured frames are copied out of the swapchain images
+    if (captureSettings.enabled)
+    {
+        if (!(swapchainSupport.surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT))
+            throw std::runtime_error("Swapchain images cannot be copied from, capture is not supported on this surface!");
+
+        swapchainCreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+
     if (vkCreateSwapchainKHR(mainDevice.logicalDevice, &swapchainCreateInfo, nullptr, &swapchain) != VK_SUCCESS)
         throw std::runtime_error("failed to create a Swapchain!");
 
@@ -208,6 +386,182 @@ void VulkanRenderer::createSwapchain()
     }
 }
 
+void VulkanRenderer::createRenderTarget()
+{
+    // Render target is blitted (upscaled) to the swapchain, both formats must support it
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(mainDevice.physicalDevice, swapchainImageFormat, &formatProperties);
+
+    const VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+    if ((formatProperties.optimalTilingFeatures & blitFeatures) != blitFeatures)
+        throw std::runtime_error("Swapchain format cannot be blitted, render target cannot be upscaled!");
+
+    // Linear filtering is optional for blits, fall back to nearest
+    upscaleFilter = (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+
+    // Allocated at full resolution once: lower render scales use a sub-rectangle, so changing scale never allocates
+    renderExtent = swapchainExtent;
+
+    // Image creation information
+    VkImageCreateInfo imageCreateInfo = {};
+    imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;                                  // Type of image (1D, 2D or 3D)
+    imageCreateInfo.format = swapchainImageFormat;                                 // Same format as the swapchain so the blit is a plain copy / filter
+    imageCreateInfo.extent = { swapchainExtent.width, swapchainExtent.height, 1 }; // Image extent (depth must be 1 for 2D images)
+    imageCreateInfo.mipLevels = 1;                                                 // Number of mipmap levels
+    imageCreateInfo.arrayLayers = 1;                                               // Number of levels in image array
+    imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;                               // Number of samples for multi-sampling
+    imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;                              // How image data should be "tiled" (arranged for optimal reading)
+    imageCreateInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT                    // Scene is rendered into it
+                          | VK_IMAGE_USAGE_TRANSFER_SRC_BIT                        // Blitted to the swapchain
+                          | VK_IMAGE_USAGE_TRANSFER_DST_BIT;                       // Scaled edge copied into its guard border
+    imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;                       // Only used by the graphics queue
+    imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;                     // Layout of image data on creation
+
+    // One per frame in flight: the scene never has to wait for the previous frame's upscale to read its render target
+    for (auto &renderTarget : renderTargets)
+    {
+        renderTarget.allocatedExtent = swapchainExtent;
+
+        if (vkCreateImage(mainDevice.logicalDevice, &imageCreateInfo, nullptr, &renderTarget.image) != VK_SUCCESS)
+            throw std::runtime_error("failed to create a Render Target image!");
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetImageMemoryRequirements(mainDevice.logicalDevice, renderTarget.image, &memoryRequirements);
+
+        const int memoryTypeIndex = findMemoryTypeIndex(mainDevice.physicalDevice, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (memoryTypeIndex < 0)
+            throw std::runtime_error("failed to find a device local memory type for the Render Target!");
+
+        // Allocate memory to image
+        VkMemoryAllocateInfo memoryAllocInfo = {};
+        memoryAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        memoryAllocInfo.allocationSize = memoryRequirements.size;
+        memoryAllocInfo.memoryTypeIndex = static_cast<uint32_t>(memoryTypeIndex);
+
+        if (vkAllocateMemory(mainDevice.logicalDevice, &memoryAllocInfo, nullptr, &renderTarget.memory) != VK_SUCCESS)
+            throw std::runtime_error("failed to allocate Render Target memory!");
+
+        vkBindImageMemory(mainDevice.logicalDevice, renderTarget.image, renderTarget.memory, 0);
+
+        // View used by the scene framebuffer
+        renderTarget.imageView = createImageView(renderTarget.image, swapchainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+    }
+}
+
+void VulkanRenderer::createRenderPass()
+{
+    // Color attachment of the render pass: the render target
+    VkAttachmentDescription colorAttachment = {};
+    colorAttachment.format = swapchainImageFormat;                          // Format to use for attachment
+    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;                        // Number of samples to write for multisampling
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;                   // Cleared at the start, only inside the render area
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;                 // Kept for the upscale blit
+    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;              // Previous content is discarded
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_GENERAL;                  // Edge guard copy reads and writes the same image, then it is blitted
+
+    VkAttachmentReference colorAttachmentReference = {};
+    colorAttachmentReference.attachment = 0;
+    colorAttachmentReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass = {};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;            // Pipeline type subpass is to be bound to
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorAttachmentReference;
+
+    std::array<VkSubpassDependency, 2> subpassDependencies;
+
+    // UNDEFINED -> COLOR_ATTACHMENT_OPTIMAL. The last use of the render target finished when its frame slot was waited on,
+    // so nothing in the transfer stage is waited for: the scene can run while the swapchain image is still being acquired
+    subpassDependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    subpassDependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    subpassDependencies[0].srcAccessMask = 0;
+    subpassDependencies[0].dstSubpass = 0;
+    subpassDependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    subpassDependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    subpassDependencies[0].dependencyFlags = 0;
+
+    // COLOR_ATTACHMENT_OPTIMAL -> GENERAL: before the edge guard copy and the blit
+    subpassDependencies[1].srcSubpass = 0;
+    subpassDependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    subpassDependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    subpassDependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+    subpassDependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    subpassDependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    subpassDependencies[1].dependencyFlags = 0;
+
+    VkRenderPassCreateInfo renderPassCreateInfo = {};
+    renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassCreateInfo.attachmentCount = 1;
+    renderPassCreateInfo.pAttachments = &colorAttachment;
+    renderPassCreateInfo.subpassCount = 1;
+    renderPassCreateInfo.pSubpasses = &subpass;
+    renderPassCreateInfo.dependencyCount = static_cast<uint32_t>(subpassDependencies.size());
+    renderPassCreateInfo.pDependencies = subpassDependencies.data();
+
+    if (vkCreateRenderPass(mainDevice.logicalDevice, &renderPassCreateInfo, nullptr, &renderPass) != VK_SUCCESS)
+        throw std::runtime_error("failed to create a Render Pass!");
+}
+
+void VulkanRenderer::createFramebuffers()
+{
+    // Cover the whole render targets, each frame only renders to renderExtent through the render area
+    for (size_t i = 0; i < renderTargets.size(); ++i)
+    {
+        VkFramebufferCreateInfo framebufferCreateInfo = {};
+        framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferCreateInfo.renderPass = renderPass;                                  // Render pass layout the framebuffer will be used with
+        framebufferCreateInfo.attachmentCount = 1;
+        framebufferCreateInfo.pAttachments = &renderTargets[i].imageView;               // List of attachments (1:1 with render pass)
+        framebufferCreateInfo.width = renderTargets[i].allocatedExtent.width;           // Framebuffer width
+        framebufferCreateInfo.height = renderTargets[i].allocatedExtent.height;         // Framebuffer height
+        framebufferCreateInfo.layers = 1;                                               // Framebuffer layers
+
+        if (vkCreateFramebuffer(mainDevice.logicalDevice, &framebufferCreateInfo, nullptr, &renderTargetFramebuffers[i]) != VK_SUCCESS)
+            throw std::runtime_error("failed to create a Render Target Framebuffer!");
+    }
+}
+
+void VulkanRenderer::createTimestampQueryPool()
+{
+    // Timings are only needed to drive the render scale
+    if (!resolutionController.isEnabled())
+        return;
+
+    // Timestamp support and precision are per queue family
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(mainDevice.physicalDevice, &queueFamilyCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> queueFamilyList(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(mainDevice.physicalDevice, &queueFamilyCount, queueFamilyList.data());
+
+    const QueueFamilyIndices indices = getQueueFamilies(mainDevice.physicalDevice);
+    const uint32_t validBits = queueFamilyList[indices.graphicsFamily].timestampValidBits;
+
+    // Without GPU timings the render scale just stays where it is
+    if (validBits == 0)
+    {
+        std::cout << "WARNING:" << "graphics queue has no timestamp support, dynamic resolution disabled" << '\n';
+        return;
+    }
+
+    timestampMask = validBits >= 64 ? std::numeric_limits<uint64_t>::max() : (uint64_t(1) << validBits) - 1;
+
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(mainDevice.physicalDevice, &deviceProperties);
+    timestampPeriod = deviceProperties.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo queryPoolCreateInfo = {};
+    queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolCreateInfo.queryCount = 2 * MAX_FRAME_DRAWS;                          // Start and end of each frame in flight
+
+    if (vkCreateQueryPool(mainDevice.logicalDevice, &queryPoolCreateInfo, nullptr, &timestampQueryPool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create the Timestamp Query Pool!");
+}
+
 void VulkanRenderer::createGraphicsPipeline()
 {
     // Read in SPIR-V code of shaders
@@ -244,6 +598,578 @@ void VulkanRenderer::createGraphicsPipeline()
     vkDestroyShaderModule(mainDevice.logicalDevice, vertexShaderModule, nullptr);
 }
 
+void VulkanRenderer::createCommandPool()
+{
+    // Get indices of queue families from device
+    QueueFamilyIndices queueFamilyIndices = getQueueFamilies(mainDevice.physicalDevice);
+
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;                  // Command buffers are re-recorded every frame
+    poolInfo.queueFamilyIndex = static_cast<uint32_t>(queueFamilyIndices.graphicsFamily); // Queue Family type that buffers from this command pool will use
+
+    // Create a Graphics Queue Family Command Pool
+    if (vkCreateCommandPool(mainDevice.logicalDevice, &poolInfo, nullptr, &graphicsCommandPool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create a Command Pool!");
+}
+
+void VulkanRenderer::createCommandBuffers()
+{
+    VkCommandBufferAllocateInfo cbAllocInfo = {};
+    cbAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cbAllocInfo.commandPool = graphicsCommandPool;
+    cbAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;                                // PRIMARY: Buffer you submit directly to queue
+    cbAllocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());      // One per frame in flight, re-recorded each frame
+
+    // Allocate command buffers and place handles in array of buffers
+    if (vkAllocateCommandBuffers(mainDevice.logicalDevice, &cbAllocInfo, commandBuffers.data()) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate Command Buffers!");
+}
+
+void VulkanRenderer::createSynchronisation()
+{
+    // Timeline Semaphore creation information
+    VkSemaphoreTypeCreateInfo timelineTypeInfo = {};
+    timelineTypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineTypeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo timelineCreateInfo = {};
+    timelineCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    timelineCreateInfo.pNext = &timelineTypeInfo;
+
+    for (auto &timeline : queueTimelines)
+    {
+        if (vkCreateSemaphore(mainDevice.logicalDevice, &timelineCreateInfo, nullptr, &timeline.semaphore) != VK_SUCCESS)
+            throw std::runtime_error("failed to create a Timeline Semaphore!");
+    }
+
+    // Binary Semaphore creation information (still needed by the swapchain)
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    for (auto &semaphore : imageAvailable)
+    {
+        if (vkCreateSemaphore(mainDevice.logicalDevice, &semaphoreCreateInfo, nullptr, &semaphore) != VK_SUCCESS)
+            throw std::runtime_error("failed to create a Semaphore!");
+    }
+
+    renderFinished.resize(swapchainImages.size());
+    for (auto &semaphore : renderFinished)
+    {
+        if (vkCreateSemaphore(mainDevice.logicalDevice, &semaphoreCreateInfo, nullptr, &semaphore) != VK_SUCCESS)
+            throw std::runtime_error("failed to create a Semaphore!");
+    }
+}
+
+void VulkanRenderer::createCaptureResources()
+{
+    if (!captureSettings.enabled)
+        return;
+
+    // Capture writes 8 bit RGBA / BGRA pixels
+    if (swapchainImageFormat != VK_FORMAT_R8G8B8A8_UNORM && swapchainImageFormat != VK_FORMAT_B8G8R8A8_UNORM)
+        throw std::runtime_error("Swapchain format is not supported by capture!");
+
+    const VkDeviceSize frameSize = static_cast<VkDeviceSize>(swapchainExtent.width) * swapchainExtent.height * FrameCapture::bytesPerPixel;
+
+    for (auto &slot : captureSlots)
+    {
+        // Buffer creation information
+        VkBufferCreateInfo bufferInfo = {};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = frameSize;                                    // Size of buffer (one full frame)
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;            // Frame is copied into it
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;             // Only used by the graphics queue
+
+        if (vkCreateBuffer(mainDevice.logicalDevice, &bufferInfo, nullptr, &slot.buffer) != VK_SUCCESS)
+            throw std::runtime_error("failed to create a Capture Buffer!");
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetBufferMemoryRequirements(mainDevice.logicalDevice, slot.buffer, &memoryRequirements);
+
+        // CPU reads the whole buffer back: prefer cached memory, reading uncached memory is very slow
+        captureMemoryCoherent = true;
+        int memoryTypeIndex = findMemoryTypeIndex(mainDevice.physicalDevice, memoryRequirements.memoryTypeBits,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        if (memoryTypeIndex < 0)
+        {
+            captureMemoryCoherent = false;
+            memoryTypeIndex = findMemoryTypeIndex(mainDevice.physicalDevice, memoryRequirements.memoryTypeBits,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+        }
+
+        if (memoryTypeIndex < 0)
+        {
+            captureMemoryCoherent = true;
+            memoryTypeIndex = findMemoryTypeIndex(mainDevice.physicalDevice, memoryRequirements.memoryTypeBits,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        }
+
+        if (memoryTypeIndex < 0)
+            throw std::runtime_error("failed to find a host visible memory type for capture!");
+
+        // Allocate memory to buffer
+        VkMemoryAllocateInfo memoryAllocInfo = {};
+        memoryAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        memoryAllocInfo.allocationSize = memoryRequirements.size;
+        memoryAllocInfo.memoryTypeIndex = static_cast<uint32_t>(memoryTypeIndex);
+
+        if (vkAllocateMemory(mainDevice.logicalDevice, &memoryAllocInfo, nullptr, &slot.memory) != VK_SUCCESS)
+            throw std::runtime_error("failed to allocate Capture Buffer memory!");
+
+        vkBindBufferMemory(mainDevice.logicalDevice, slot.buffer, slot.memory, 0);
+
+        // Mapped once for the lifetime of the buffer, the writer thread reads straight from it
+        void* mappedData;
+        if (vkMapMemory(mainDevice.logicalDevice, slot.memory, 0, frameSize, 0, &mappedData) != VK_SUCCESS)
+            throw std::runtime_error("failed to map Capture Buffer memory!");
+
+        slot.mappedData = static_cast<uint8_t*>(mappedData);
+    }
+}
+
+/// Record the commands of the frame into the current frame command buffer.
+/// If captureSlot is not -1, the final image is also copied into that readback buffer.
+void VulkanRenderer::recordCommands(const uint32_t imageIndex, const int captureSlot) const
+{
+    const VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
+    const RenderTarget& renderTarget = renderTargets[currentFrame];
+
+    // Information about how to begin each command buffer
+    VkCommandBufferBeginInfo bufferBeginInfo = {};
+    bufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    bufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;    // Buffer is re-recorded before its next submission
+
+    if (vkBeginCommandBuffer(commandBuffer, &bufferBeginInfo) != VK_SUCCESS)
+        throw std::runtime_error("failed to start recording a Command Buffer!");
+
+    VkImageSubresourceRange colorRange = {};
+    colorRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    colorRange.baseMipLevel = 0;
+    colorRange.levelCount = 1;
+    colorRange.baseArrayLayer = 0;
+    colorRange.layerCount = 1;
+
+    // -- TIMESTAMP START --
+    // Only the scene is timed: it does not wait for the swapchain image, so the measure never includes that wait
+    const uint32_t firstQuery = static_cast<uint32_t>(currentFrame) * 2;
+    if (timestampQueryPool != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(commandBuffer, timestampQueryPool, firstQuery, 2);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampQueryPool, firstQuery);
+    }
+
+    // -- SCENE --
+    // Render area limited to renderExtent: clear (and later draws) only touch the scaled part of the render target
+    VkClearValue clearValue = {};
+    clearValue.color.float32[0] = 0.6f;
+    clearValue.color.float32[1] = 0.65f;
+    clearValue.color.float32[2] = 0.4f;
+    clearValue.color.float32[3] = 1.0f;
+
+    VkRenderPassBeginInfo renderPassBeginInfo = {};
+    renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassBeginInfo.renderPass = renderPass;                        // Render pass to begin
+    renderPassBeginInfo.framebuffer = renderTargetFramebuffers[currentFrame];   // Framebuffer to render to
+    renderPassBeginInfo.renderArea.offset = { 0, 0 };                   // Start point of render pass in pixels
+    renderPassBeginInfo.renderArea.extent = renderExtent;               // Size of region to run render pass on
+    renderPassBeginInfo.clearValueCount = 1;
+    renderPassBeginInfo.pClearValues = &clearValue;                     // List of clear values
+
+    vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    // Graphics pipeline draws go here (viewport and scissor set to renderExtent)
+
+    // Render pass ends with the render target in GENERAL
+    vkCmdEndRenderPass(commandBuffer);
+
+    // -- TIMESTAMP END --
+    // Upscale and capture costs do not depend on the render scale, they are left out
+    if (timestampQueryPool != VK_NULL_HANDLE)
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, timestampQueryPool, firstQuery + 1);
+
+    // -- UPSCALE --
+    // A linear blit filters the last scaled column and row with the next texel, which the scene never renders.
+    // Replicate the edge into that 1 texel guard border so the upscaled image is clamped at its own edge.
+    // At full scale the edge is the image edge, which the blit already clamps to
+    const bool guardColumn = upscaleFilter == VK_FILTER_LINEAR && renderExtent.width < renderTarget.allocatedExtent.width;
+    const bool guardRow = upscaleFilter == VK_FILTER_LINEAR && renderExtent.height < renderTarget.allocatedExtent.height;
+    const int32_t lastColumn = static_cast<int32_t>(renderExtent.width) - 1;
+    const int32_t lastRow = static_cast<int32_t>(renderExtent.height) - 1;
+
+    std::array<VkImageCopy, 3> guardRegions;
+    uint32_t guardRegionCount = 0;
+
+    VkImageCopy edgeCopy = {};
+    edgeCopy.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    edgeCopy.srcSubresource.mipLevel = 0;
+    edgeCopy.srcSubresource.baseArrayLayer = 0;
+    edgeCopy.srcSubresource.layerCount = 1;
+    edgeCopy.dstSubresource = edgeCopy.srcSubresource;
+
+    if (guardColumn)
+    {
+        edgeCopy.srcOffset = { lastColumn, 0, 0 };
+        edgeCopy.dstOffset = { lastColumn + 1, 0, 0 };
+        edgeCopy.extent = { 1, renderExtent.height, 1 };
+        guardRegions[guardRegionCount++] = edgeCopy;
+    }
+
+    if (guardRow)
+    {
+        edgeCopy.srcOffset = { 0, lastRow, 0 };
+        edgeCopy.dstOffset = { 0, lastRow + 1, 0 };
+        edgeCopy.extent = { renderExtent.width, 1, 1 };
+        guardRegions[guardRegionCount++] = edgeCopy;
+    }
+
+    if (guardColumn && guardRow)
+    {
+        edgeCopy.srcOffset = { lastColumn, lastRow, 0 };
+        edgeCopy.dstOffset = { lastColumn + 1, lastRow + 1, 0 };
+        edgeCopy.extent = { 1, 1, 1 };
+        guardRegions[guardRegionCount++] = edgeCopy;
+    }
+
+    // Regions never overlap: sources are inside renderExtent, destinations outside it
+    if (guardRegionCount > 0)
+        vkCmdCopyImage(commandBuffer, renderTarget.image, VK_IMAGE_LAYOUT_GENERAL, renderTarget.image, VK_IMAGE_LAYOUT_GENERAL, guardRegionCount, guardRegions.data());
+
+    // Swapchain image previous content is discarded, it is fully overwritten by the blit
+    VkImageMemoryBarrier swapchainBarrier = {};
+    swapchainBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    swapchainBarrier.srcAccessMask = 0;
+    swapchainBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    swapchainBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    swapchainBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    swapchainBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    swapchainBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    swapchainBarrier.image = swapchainImages[imageIndex].image;
+    swapchainBarrier.subresourceRange = colorRange;
+
+    // Guard border is read by the blit
+    VkImageMemoryBarrier guardBarrier = swapchainBarrier;
+    guardBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    guardBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    guardBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    guardBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    guardBarrier.image = renderTarget.image;
+
+    VkImageMemoryBarrier blitBarriers[] = { swapchainBarrier, guardBarrier };
+    const uint32_t blitBarrierCount = guardRegionCount > 0 ? 2 : 1;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, blitBarrierCount, blitBarriers);
+
+    // Scaled part of the render target stretched over the whole swapchain image
+    VkImageBlit blitRegion = {};
+    blitRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blitRegion.srcSubresource.mipLevel = 0;
+    blitRegion.srcSubresource.baseArrayLayer = 0;
+    blitRegion.srcSubresource.layerCount = 1;
+    blitRegion.srcOffsets[0] = { 0, 0, 0 };
+    blitRegion.srcOffsets[1] = { static_cast<int32_t>(renderExtent.width), static_cast<int32_t>(renderExtent.height), 1 };
+    blitRegion.dstSubresource = blitRegion.srcSubresource;
+    blitRegion.dstOffsets[0] = { 0, 0, 0 };
+    blitRegion.dstOffsets[1] = { static_cast<int32_t>(swapchainExtent.width), static_cast<int32_t>(swapchainExtent.height), 1 };
+
+    vkCmdBlitImage(commandBuffer, renderTarget.image, VK_IMAGE_LAYOUT_GENERAL,
+        swapchainImages[imageIndex].image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blitRegion, upscaleFilter);
+
+    VkImageLayout imageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    VkAccessFlags imageAccess = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    // -- CAPTURE --
+    if (captureSlot >= 0)
+    {
+        // Final image is read by the copy
+        VkImageMemoryBarrier copyBarrier = swapchainBarrier;
+        copyBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        copyBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        copyBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        copyBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &copyBarrier);
+
+        // Whole image, tightly packed in the buffer
+        VkBufferImageCopy copyRegion = {};
+        copyRegion.bufferOffset = 0;
+        copyRegion.bufferRowLength = 0;                                     // 0: rows are tightly packed
+        copyRegion.bufferImageHeight = 0;
+        copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copyRegion.imageSubresource.mipLevel = 0;
+        copyRegion.imageSubresource.baseArrayLayer = 0;
+        copyRegion.imageSubresource.layerCount = 1;
+        copyRegion.imageOffset = { 0, 0, 0 };
+        copyRegion.imageExtent = { swapchainExtent.width, swapchainExtent.height, 1 };
+
+        vkCmdCopyImageToBuffer(commandBuffer, swapchainImages[imageIndex].image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, captureSlots[captureSlot].buffer, 1, &copyRegion);
+
+        // Make the copy visible to the host once the timeline value of this submission is reached
+        VkBufferMemoryBarrier hostBarrier = {};
+        hostBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        hostBarrier.buffer = captureSlots[captureSlot].buffer;
+        hostBarrier.offset = 0;
+        hostBarrier.size = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+
+        imageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        imageAccess = VK_ACCESS_TRANSFER_READ_BIT;
+    }
+
+    // Image is then handed to the presentation engine
+    VkImageMemoryBarrier presentBarrier = swapchainBarrier;
+    presentBarrier.srcAccessMask = imageAccess;
+    presentBarrier.dstAccessMask = 0;
+    presentBarrier.oldLayout = imageLayout;
+    presentBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &presentBarrier);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to stop recording a Command Buffer!");
+}
+
+void VulkanRenderer::updateRenderExtent()
+{
+    if (frameTimestampsWritten[currentFrame])
+    {
+        // Frame slot was waited on, the results are there: no WAIT flag, never stall here
+        uint64_t timestamps[2];
+        const uint32_t firstQuery = static_cast<uint32_t>(currentFrame) * 2;
+
+        if (vkGetQueryPoolResults(mainDevice.logicalDevice, timestampQueryPool, firstQuery, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+        {
+            const uint64_t elapsedTicks = (timestamps[1] - timestamps[0]) & timestampMask;
+            const double gpuSceneTimeMs = static_cast<double>(elapsedTicks) * timestampPeriod / 1000000.0;
+
+            resolutionController.update(gpuSceneTimeMs);
+        }
+
+        frameTimestampsWritten[currentFrame] = false;
+    }
+
+    // Only the extent changes with the scale, the render target allocations stay the same
+    const float scale = resolutionController.getScale();
+    const VkExtent2D allocatedExtent = renderTargets[currentFrame].allocatedExtent;
+    renderExtent.width = std::max(1u, std::min(allocatedExtent.width, static_cast<uint32_t>(allocatedExtent.width * scale + 0.5f)));
+    renderExtent.height = std::max(1u, std::min(allocatedExtent.height, static_cast<uint32_t>(allocatedExtent.height * scale + 0.5f)));
+}
+
+void VulkanRenderer::collectCapturedFrames()
+{
+    if (!captureSettings.enabled)
+        return;
+
+    // Slots the writer thread is done with can receive new frames
+    uint32_t releasedSlot;
+    while (frameCapture.popReleasedSlot(releasedSlot))
+        captureSlots[releasedSlot].state = CAPTURE_SLOT_FREE;
+
+    // Hand over finished copies in frame order. Never waits: slots still in flight are collected on a later frame
+    while (captureSlots[oldestCaptureSlot].state == CAPTURE_SLOT_IN_FLIGHT && isTimelinePointComplete(captureSlots[oldestCaptureSlot].lastUse))
+    {
+        CaptureSlot &slot = captureSlots[oldestCaptureSlot];
+
+        if (!captureMemoryCoherent)
+        {
+            VkMappedMemoryRange memoryRange = {};
+            memoryRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+            memoryRange.memory = slot.memory;
+            memoryRange.offset = 0;
+            memoryRange.size = VK_WHOLE_SIZE;
+
+            vkInvalidateMappedMemoryRanges(mainDevice.logicalDevice, 1, &memoryRange);
+        }
+
+        CapturedFrame frame = {};
+        frame.slot = oldestCaptureSlot;
+        frame.frameNumber = slot.frameNumber;
+        frame.data = slot.mappedData;
+
+        // Queue holds more frames than the ring has slots, the push cannot fail
+        frameCapture.submitFrame(frame);
+        slot.state = CAPTURE_SLOT_WRITING;
+
+        oldestCaptureSlot = (oldestCaptureSlot + 1) % CAPTURE_RING_SIZE;
+    }
+}
+
+void VulkanRenderer::processWindowEvents(WindowEventQueue& events)
+{
+    WindowEvent event;
+    while (events.pop(event))
+    {
+        // Events are queued in order, the first one popped this frame is the oldest
+        if (frameEventCount == 0)
+        {
+            frameFirstEventTimestamp = event.timestamp;
+            frameEventDelayTotalMs = 0.0;
+        }
+        else
+            frameEventDelayTotalMs += std::chrono::duration<double, std::milli>(event.timestamp - frameFirstEventTimestamp).count();
+
+        ++frameEventCount;
+
+        switch (event.type)
+        {
+        case WINDOW_EVENT_FRAMEBUFFER_RESIZE:
+            // A 0 sized framebuffer is what GLFW reports when minimised
+            windowMinimised = event.width == 0 || event.height == 0;
+            break;
+        case WINDOW_EVENT_ICONIFY:
+            windowMinimised = event.action == GLFW_TRUE;
+            break;
+        default:
+            // Input is not consumed by anything yet, it is only used to measure latency
+            break;
+        }
+    }
+}
+
+/// Present time is the closest we get to photon without present timing extensions:
+/// it does not include the presentation engine and display scan-out
+void VulkanRenderer::reportInputLatency(const std::chrono::steady_clock::time_point presentTime)
+{
+    constexpr uint32_t reportSampleCount = 500;    // Number of events averaged per report
+
+    if (frameEventCount > 0)
+    {
+        // Each event waited the oldest one's latency minus its delay after it
+        const double oldestLatencyMs = std::chrono::duration<double, std::milli>(presentTime - frameFirstEventTimestamp).count();
+
+        inputLatencyTotalMs += frameEventCount * oldestLatencyMs - frameEventDelayTotalMs;
+        inputLatencyMaxMs = std::max(inputLatencyMaxMs, oldestLatencyMs);
+        inputLatencySampleCount += frameEventCount;
+
+        frameEventCount = 0;
+    }
+
+    if (inputLatencySampleCount < reportSampleCount)
+        return;
+
+    std::cout << "Input latency (event -> present): avg " << inputLatencyTotalMs / inputLatencySampleCount
+              << " ms, max " << inputLatencyMaxMs << " ms over " << inputLatencySampleCount << " events" << '\n';
+
+    inputLatencyTotalMs = 0.0;
+    inputLatencyMaxMs = 0.0;
+    inputLatencySampleCount = 0;
+}
+
+/// Submit a command buffer to the queue owning the given timeline.
+/// The submission signals the next value of the timeline, which is returned so resources can record their last use.
+/// Wait points can be on any timeline (e.g. transfer -> graphics), points already reached are skipped.
+TimelinePoint VulkanRenderer::submitToQueue(const QueueTimelineType type, const VkCommandBuffer commandBuffer, const std::initializer_list<TimelinePoint> waitPoints, const BinarySemaphoreLink& binaryLink)
+{
+    QueueTimeline &timeline = queueTimelines[type];
+
+    TimelinePoint signalPoint = {};
+    signalPoint.timeline = type;
+    signalPoint.value = timeline.lastSubmittedValue + 1;
+
+    // Only the highest value per timeline needs a wait, it implies all the lower ones (0 = no wait)
+    std::array<uint64_t, QUEUE_TIMELINE_COUNT> timelineWaitValues = {};
+    for (const auto &point : waitPoints)
+    {
+        if (!isTimelinePointComplete(point))
+            timelineWaitValues[point.timeline] = std::max(timelineWaitValues[point.timeline], point.value);
+    }
+
+    // Semaphores to wait on with their value (ignored for binary semaphores). At most one per timeline + the binary one
+    std::array<VkSemaphore, QUEUE_TIMELINE_COUNT + 1> waitSemaphores;
+    std::array<uint64_t, QUEUE_TIMELINE_COUNT + 1> waitValues;
+    std::array<VkPipelineStageFlags, QUEUE_TIMELINE_COUNT + 1> waitStages;
+    uint32_t waitCount = 0;
+
+    for (uint32_t i = 0; i < QUEUE_TIMELINE_COUNT; ++i)
+    {
+        if (timelineWaitValues[i] == 0)
+            continue;
+
+        waitSemaphores[waitCount] = queueTimelines[i].semaphore;
+        waitValues[waitCount] = timelineWaitValues[i];
+        waitStages[waitCount] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        ++waitCount;
+    }
+
+    if (binaryLink.waitSemaphore != VK_NULL_HANDLE)
+    {
+        waitSemaphores[waitCount] = binaryLink.waitSemaphore;
+        waitValues[waitCount] = 0;
+        waitStages[waitCount] = binaryLink.waitStage;
+        ++waitCount;
+    }
+
+    // Semaphores to signal with their value. The timeline one always comes first
+    std::array<VkSemaphore, 2> signalSemaphores = { timeline.semaphore, binaryLink.signalSemaphore };
+    std::array<uint64_t, 2> signalValues = { signalPoint.value, 0 };
+    const uint32_t signalCount = binaryLink.signalSemaphore != VK_NULL_HANDLE ? 2 : 1;
+
+    VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineSubmitInfo.waitSemaphoreValueCount = waitCount;
+    timelineSubmitInfo.pWaitSemaphoreValues = waitValues.data();
+    timelineSubmitInfo.signalSemaphoreValueCount = signalCount;
+    timelineSubmitInfo.pSignalSemaphoreValues = signalValues.data();
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineSubmitInfo;
+    submitInfo.waitSemaphoreCount = waitCount;                                         // Number of semaphores to wait on
+    submitInfo.pWaitSemaphores = waitSemaphores.data();                                // List of semaphores to wait on
+    submitInfo.pWaitDstStageMask = waitStages.data();                                  // Stages to check semaphores at
+    submitInfo.commandBufferCount = 1;                                                 // Number of command buffers to submit
+    submitInfo.pCommandBuffers = &commandBuffer;                                       // Command buffer to submit
+    submitInfo.signalSemaphoreCount = signalCount;                                     // Number of semaphores to signal
+    submitInfo.pSignalSemaphores = signalSemaphores.data();                            // Semaphores to signal when command buffer finishes
+
+    // No fence: CPU side waits go through the timeline value
+    if (vkQueueSubmit(timeline.queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        throw std::runtime_error("failed to submit Command Buffer to Queue!");
+
+    timeline.lastSubmittedValue = signalPoint.value;
+
+    return signalPoint;
+}
+
+bool VulkanRenderer::isTimelinePointComplete(const TimelinePoint& point)
+{
+    QueueTimeline &timeline = queueTimelines[point.timeline];
+
+    // Cached value first, only ask the GPU if the point may have been reached since
+    if (timeline.completedValue >= point.value)
+        return true;
+
+    if (vkGetSemaphoreCounterValue(mainDevice.logicalDevice, timeline.semaphore, &timeline.completedValue) != VK_SUCCESS)
+        throw std::runtime_error("failed to read Timeline Semaphore value!");
+
+    return timeline.completedValue >= point.value;
+}
+
+void VulkanRenderer::waitForTimelinePoint(const TimelinePoint& point)
+{
+    if (isTimelinePointComplete(point))
+        return;
+
+    QueueTimeline &timeline = queueTimelines[point.timeline];
+
+    VkSemaphoreWaitInfo waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &timeline.semaphore;
+    waitInfo.pValues = &point.value;
+
+    if (vkWaitSemaphores(mainDevice.logicalDevice, &waitInfo, std::numeric_limits<uint64_t>::max()) != VK_SUCCESS)
+        throw std::runtime_error("failed to wait on Timeline Semaphore!");
+
+    timeline.completedValue = std::max(timeline.completedValue, point.value);
+}
+
 VkImageView VulkanRenderer::createImageView(const VkImage image, const VkFormat format, VkImageAspectFlags aspectFlags) const
 {
     VkImageViewCreateInfo viewCreateInfo = {};
@@ -301,6 +1227,7 @@ void VulkanRenderer::getPhysicalDevice()
     std::vector<VkPhysicalDevice> physicalDevicesList(physicalDevicesCount);
     vkEnumeratePhysicalDevices(instance, &physicalDevicesCount, physicalDevicesList.data());
 
+    mainDevice.physicalDevice = VK_NULL_HANDLE;
     for (const auto &device : physicalDevicesList)
     {
         if (checkPhysicalDeviceSuitable(device))
@@ -309,6 +1236,9 @@ void VulkanRenderer::getPhysicalDevice()
             break;
         }
     } 
+
+    if (mainDevice.physicalDevice == VK_NULL_HANDLE)
+        throw std::runtime_error("failed to find a suitable GPU (Vulkan 1.2 with timeline semaphores, swapchain support)!");
 }
 
 QueueFamilyIndices VulkanRenderer::getQueueFamilies(const VkPhysicalDevice physicalDevice) const
@@ -383,15 +1313,25 @@ SwapchainSupportDetails VulkanRenderer::getSwapchainDetails(const VkPhysicalDevi
 
 bool VulkanRenderer::checkPhysicalDeviceSuitable(const VkPhysicalDevice physicalDevice)
 {
-    /* Commented for now. We will check properties and features later
     // Information about the device itself (ID, name, type, vendor, etc...)
     VkPhysicalDeviceProperties deviceProperties;
     vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
 
-    // Information about what the device can do (geo shader, tess shader, wide lines, etc...)
-    VkPhysicalDeviceFeatures deviceFeatures;
-    vkGetPhysicalDeviceFeatures(physicalDevice, &deviceFeatures);
-     */
+    // Timeline semaphores are core since Vulkan 1.2
+    if (deviceProperties.apiVersion < VK_API_VERSION_1_2)
+        return false;
+
+    // Information about what the device can do (geo shader, tess shader, wide lines, timeline semaphores, etc...)
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 deviceFeatures = {};
+    deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    deviceFeatures.pNext = &vulkan12Features;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &deviceFeatures);
+
+    if (!vulkan12Features.timelineSemaphore)
+        return false;
 
     QueueFamilyIndices indices = getQueueFamilies(physicalDevice);
     bool extensionsSupported = checkDeviceExtensionSupport(physicalDevice);
@@ -1 +1,124 @@
 #include "../Public/VulkanWindow.h"
+
+// std
+#include <iostream>
+
+int VulkanWindow::init(const std::string& w_name, const int width, const int height)
+{
+    if (glfwInit() != GLFW_TRUE)
+    {
+        std::cout << "ERROR:" << "failed to initialise GLFW!" << '\n';
+        return EXIT_FAILURE;
+    }
+
+    // Set glfw to not work with another graphic API other than Vulkan
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+
+    window = glfwCreateWindow(width, height, w_name.c_str(), nullptr, nullptr);
+
+    if (window == nullptr)
+    {
+        std::cout << "ERROR:" << "failed to create GLFW window!" << '\n';
+        return EXIT_FAILURE;
+    }
+
+    // Callbacks are static, they find back this instance through the window user pointer
+    glfwSetWindowUserPointer(window, this);
+    glfwSetKeyCallback(window, keyCallback);
+    glfwSetMouseButtonCallback(window, mouseButtonCallback);
+    glfwSetCursorPosCallback(window, cursorPositionCallback);
+    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+    glfwSetWindowIconifyCallback(window, iconifyCallback);
+
+    return 0;
+}
+
+void VulkanWindow::cleanup() const
+{
+    if (droppedEventCount > 0)
+        std::cout << "WARNING:" << droppedEventCount << " window events dropped, the render thread did not keep up" << '\n';
+
+    // Destroy GLFW Window and stop GLFW
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
+
+void VulkanWindow::waitEvents() const
+{
+    // Sleep until an event comes in. The render thread runs on its own so there is no need to spin here
+    glfwWaitEvents();
+}
+
+bool VulkanWindow::shouldClose() const
+{
+    return glfwWindowShouldClose(window);
+}
+
+void VulkanWindow::requestClose() const
+{
+    glfwSetWindowShouldClose(window, GLFW_TRUE);
+
+    // Wake up the main thread in case it is waiting for events
+    glfwPostEmptyEvent();
+}
+
+void VulkanWindow::keyCallback(GLFWwindow* glfwWindow, const int key, int scancode, const int action, const int mods)
+{
+    WindowEvent event = {};
+    event.type = WINDOW_EVENT_KEY;
+    event.code = key;
+    event.action = action;
+    event.mods = mods;
+
+    static_cast<VulkanWindow*>(glfwGetWindowUserPointer(glfwWindow))->pushEvent(event);
+}
+
+void VulkanWindow::mouseButtonCallback(GLFWwindow* glfwWindow, const int button, const int action, const int mods)
+{
+    WindowEvent event = {};
+    event.type = WINDOW_EVENT_MOUSE_BUTTON;
+    event.code = button;
+    event.action = action;
+    event.mods = mods;
+
+    static_cast<VulkanWindow*>(glfwGetWindowUserPointer(glfwWindow))->pushEvent(event);
+}
+
+void VulkanWindow::cursorPositionCallback(GLFWwindow* glfwWindow, const double x, const double y)
+{
+    WindowEvent event = {};
+    event.type = WINDOW_EVENT_CURSOR_POSITION;
+    event.cursorX = x;
+    event.cursorY = y;
+
+    static_cast<VulkanWindow*>(glfwGetWindowUserPointer(glfwWindow))->pushEvent(event);
+}
+
+void VulkanWindow::framebufferSizeCallback(GLFWwindow* glfwWindow, const int width, const int height)
+{
+    WindowEvent event = {};
+    event.type = WINDOW_EVENT_FRAMEBUFFER_RESIZE;
+    event.width = width;
+    event.height = height;
+
+    static_cast<VulkanWindow*>(glfwGetWindowUserPointer(glfwWindow))->pushEvent(event);
+}
+
+void VulkanWindow::iconifyCallback(GLFWwindow* glfwWindow, const int iconified)
+{
+    WindowEvent event = {};
+    event.type = WINDOW_EVENT_ICONIFY;
+    event.action = iconified;
+
+    static_cast<VulkanWindow*>(glfwGetWindowUserPointer(glfwWindow))->pushEvent(event);
+}
+
+void VulkanWindow::pushEvent(WindowEvent event)
+{
+    event.timestamp = std::chrono::steady_clock::now();
+
+    // Never block the window thread: if the render thread is that far behind, drop the event
+    if (!eventQueue.push(event))
+        ++droppedEventCount;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+struct DynamicResolutionSettings
+{
+    bool enabled = true;
+    double targetFrameTimeMs = 1000.0 / 60.0;   // GPU scene time budget to hold (the upscale is not counted)
+    float minScale = 0.5f;                      // Smallest render scale, per axis
+    float maxScale = 1.0f;                      // Largest render scale, per axis (1 = swapchain resolution)
+};
+
+/// Picks the render scale from measured GPU frame times so the frame stays within its budget
+class DynamicResolutionController
+{
+public:
+    DynamicResolutionController() = default;
+    ~DynamicResolutionController() = default;
+
+    void init(const DynamicResolutionSettings& new_settings);
+    float update(double gpuFrameTimeMs);
+
+    float getScale() const { return scale; }
+    bool isEnabled() const { return settings.enabled; }
+
+private:
+    DynamicResolutionSettings settings;
+
+    float scale = 1.0f;
+    double smoothedFrameTimeMs = 0.0;
+    bool hasSample = false;
+    int framesSinceChange = 0;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// src
+#include "SpscQueue.h"
+
+enum CaptureFormat
+{
+    CAPTURE_FORMAT_RAW,     // Every frame appended to a single file, tightly packed RGBA8
+    CAPTURE_FORMAT_Y4M,     // Single YUV4MPEG2 video stream (4:4:4), readable by ffmpeg and most video tools
+    CAPTURE_FORMAT_PPM      // One binary PPM image per frame, for regression image diffs
+};
+
+struct CaptureSettings
+{
+    bool enabled = false;
+    CaptureFormat format = CAPTURE_FORMAT_RAW;
+    std::string path = "capture";       // Output file. For PPM: prefix of the per-frame files
+};
+
+/// A frame copied back from the GPU, waiting to be written to disk
+struct CapturedFrame
+{
+    uint32_t slot = 0;                  // Readback slot holding the data, handed back once written
+    uint64_t frameNumber = 0;
+    const uint8_t* data = nullptr;      // Mapped readback memory, width * height * 4 bytes
+};
+
+/// Writes captured frames to disk on a background thread.
+/// The render thread hands frames over and gets their readback slots back through lock-free queues, it never waits on disk.
+class FrameCapture
+{
+public:
+    FrameCapture() = default;
+    ~FrameCapture();
+
+    void start(const CaptureSettings& new_settings, uint32_t new_width, uint32_t new_height, bool new_bgra);
+    void stop();
+
+    // Render thread only
+    bool submitFrame(const CapturedFrame& frame);
+    bool popReleasedSlot(uint32_t& slot);
+    void countDroppedFrame() { ++droppedFrameCount; }
+
+    static constexpr uint32_t bytesPerPixel = 4;
+
+private:
+    void writerLoop();
+    void writeFrame(const CapturedFrame& frame);
+
+    // Format writers. Return false if the frame could not be written
+    bool writeRaw(const uint8_t* pixels);
+    bool writeY4m(const uint8_t* pixels);
+    bool writePpm(const uint8_t* pixels, uint64_t frameNumber);
+
+private:
+    CaptureSettings settings;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    bool bgra = false;                  // Source pixels are BGRA (swapchain format), swizzled to RGB when written
+
+    // Thread communication: frames render -> writer, slots writer -> render
+    SpscQueue<CapturedFrame, 16> pendingFrames;
+    SpscQueue<uint32_t, 16> releasedSlots;
+    std::thread writerThread;
+    std::atomic<bool> stopWriter { false };
+
+    // Writer thread only
+    std::ofstream file;
+    std::vector<uint8_t> conversionBuffer;     // Allocated once, holds swizzled / converted pixels
+    uint64_t writtenFrameCount = 0;
+    uint64_t failedFrameCount = 0;      // Frames lost to I/O errors (disk full, file cannot be opened...)
+    uint64_t writtenByteCount = 0;
+    std::chrono::steady_clock::duration writeTime {};
+
+    // Render thread only
+    uint64_t droppedFrameCount = 0;     // Frames skipped because every readback slot was busy
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+// std
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/// Lock-free queue between exactly one producer thread and one consumer thread.
+/// Indices only grow, the slot is the index masked by the capacity (which must be a power of two).
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() = default;
+    ~SpscQueue() = default;
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer thread only. Returns false if the queue is full, the item is then not pushed
+    bool push(const T& item)
+    {
+        const size_t currentTail = tail.load(std::memory_order_relaxed);
+
+        // Acquire: the consumer must be done reading the slot before we overwrite it
+        if (currentTail - head.load(std::memory_order_acquire) == Capacity)
+            return false;
+
+        items[currentTail & (Capacity - 1)] = item;
+
+        // Release: the item is written before the consumer can see the new tail
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. Returns false if the queue is empty
+    bool pop(T& item)
+    {
+        const size_t currentHead = head.load(std::memory_order_relaxed);
+
+        // Acquire: the producer's write of the item is visible once we see its tail
+        if (currentHead == tail.load(std::memory_order_acquire))
+            return false;
+
+        item = items[currentHead & (Capacity - 1)];
+
+        // Release: the slot is read before the producer can reuse it
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // Head and tail on their own cache line so both threads don't fight over the same line
+    alignas(64) std::atomic<size_t> head { 0 };    // Next index to read, written by the consumer
+    alignas(64) std::atomic<size_t> tail { 0 };    // Next index to write, written by the producer
+    alignas(64) std::array<T, Capacity> items;
+};
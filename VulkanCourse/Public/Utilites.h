@@ -2,6 +2,12 @@
 
 #include <fstream>
 
+// Number of frames the CPU can record ahead of the GPU
+constexpr int MAX_FRAME_DRAWS = 2;
+
+// Number of readback buffers captured frames are copied into. A buffer is collected once the GPU is done with it
+constexpr int CAPTURE_RING_SIZE = MAX_FRAME_DRAWS + 2;
+
 const std::vector<const char*> deviceExtensions = {
     VK_KHR_SWAPCHAIN_EXTENSION_NAME
 };
@@ -32,6 +38,82 @@ struct SwapchainImage
     VkImageView imageView;
 };
 
+/// Image the scene is rendered into before being upscaled to the swapchain
+struct RenderTarget
+{
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView imageView = VK_NULL_HANDLE;
+    VkExtent2D allocatedExtent = {};            // Size of the allocation. Scaled frames only use the top left part of it
+};
+
+/// Queues that own a timeline semaphore. Used as index in the renderer's timeline list
+enum QueueTimelineType
+{
+    QUEUE_TIMELINE_GRAPHICS = 0,
+    QUEUE_TIMELINE_COUNT
+};
+
+/// A timeline semaphore owned by a single queue. Every submission on the queue signals the next value
+struct QueueTimeline
+{
+    VkQueue queue = VK_NULL_HANDLE;             // Queue submitting the work
+    VkSemaphore semaphore = VK_NULL_HANDLE;     // Timeline semaphore signaled at the end of each submission
+    uint64_t lastSubmittedValue = 0;            // Value that will be reached once all submitted work is done
+    uint64_t completedValue = 0;                // Last value read back from the GPU (cached to avoid a query)
+};
+
+/// A point on a queue timeline. Resources store the point of their last use,
+/// checking if the GPU is done with them is then a single integer comparison
+struct TimelinePoint
+{
+    QueueTimelineType timeline = QUEUE_TIMELINE_GRAPHICS;
+    uint64_t value = 0;                         // 0 is reached at creation, so a default point is always complete
+};
+
+/// Binary semaphores still needed around a submission. Swapchain acquire and present cannot use timeline semaphores
+struct BinarySemaphoreLink
+{
+    VkSemaphore waitSemaphore = VK_NULL_HANDLE;
+    VkPipelineStageFlags waitStage = 0;
+    VkSemaphore signalSemaphore = VK_NULL_HANDLE;
+};
+
+enum CaptureSlotState
+{
+    CAPTURE_SLOT_FREE,          // Can receive the next captured frame
+    CAPTURE_SLOT_IN_FLIGHT,     // GPU copy submitted, not known to be complete yet
+    CAPTURE_SLOT_WRITING        // Owned by the capture writer thread until it hands it back
+};
+
+/// Host visible buffer a frame is copied into for capture
+struct CaptureSlot
+{
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    uint8_t* mappedData = nullptr;                  // Persistently mapped
+    CaptureSlotState state = CAPTURE_SLOT_FREE;
+    TimelinePoint lastUse;                          // Submission copying the frame into the buffer
+    uint64_t frameNumber = 0;
+};
+
+/// Returns the index of a memory type allowed by the resource and having all the given properties, -1 if there is none
+static int findMemoryTypeIndex(const VkPhysicalDevice physicalDevice, const uint32_t allowedTypes, const VkMemoryPropertyFlags properties)
+{
+    // Get properties of physical device memory
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
+    {
+        if ((allowedTypes & (1u << i))                                                      // Index of memory type must match corresponding bit in allowedTypes
+            && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)  // Desired property bit flags are part of memory type's property flags
+            return static_cast<int>(i);
+    }
+
+    return -1;
+}
+
 static std::vector<char> readFile(const std::string& filename)
 {
     // Open stream from given file.
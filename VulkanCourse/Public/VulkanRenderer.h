@@ -6,13 +6,20 @@
 #include <iostream>
 #include <set>
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <initializer_list>
+#include <limits>
 
 // glfw
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
 // src
+#include "DynamicResolution.h"
+#include "FrameCapture.h"
 #include "Utilites.h"
+#include "VulkanWindow.h"
 
 class VulkanRenderer
 {
@@ -20,8 +27,9 @@ public:
     VulkanRenderer() = default;
     ~VulkanRenderer() = default;
 
-    int init(GLFWwindow* new_window);
-    void cleanup() const;
+    int init(GLFWwindow* new_window, const CaptureSettings& new_captureSettings = {}, const DynamicResolutionSettings& new_resolutionSettings = {});
+    bool draw(WindowEventQueue& events);
+    void cleanup();
 
 // Vulkan Functions
 private:
@@ -31,6 +39,32 @@ private:
     void createSurface();
     void createSwapchain();
     void createGraphicsPipeline();
+    void createCommandPool();
+    void createCommandBuffers();
+    void createSynchronisation();
+    void createCaptureResources();
+    void createRenderTarget();
+    void createRenderPass();
+    void createFramebuffers();
+    void createTimestampQueryPool();
+
+    // Record functions
+    void recordCommands(uint32_t imageIndex, int captureSlot) const;
+
+    // Dynamic resolution functions
+    void updateRenderExtent();
+
+    // Capture functions
+    void collectCapturedFrames();
+
+    // Window event functions
+    void processWindowEvents(WindowEventQueue& events);
+    void reportInputLatency(std::chrono::steady_clock::time_point presentTime);
+
+    // Timeline functions
+    TimelinePoint submitToQueue(QueueTimelineType type, VkCommandBuffer commandBuffer, std::initializer_list<TimelinePoint> waitPoints, const BinarySemaphoreLink& binaryLink = {});
+    bool isTimelinePointComplete(const TimelinePoint& point);
+    void waitForTimelinePoint(const TimelinePoint& point);
 
     // Creat Utilities functions
     VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) const;
@@ -64,15 +98,59 @@ private:
     VkQueue graphicsQueue;
     VkQueue presentQueue;
 
+    // Synchronisation
+    std::array<QueueTimeline, QUEUE_TIMELINE_COUNT> queueTimelines;    // One timeline semaphore per submitting queue
+    std::array<TimelinePoint, MAX_FRAME_DRAWS> frameTimelinePoints;     // Last submission of each frame in flight (replaces per frame fences)
+    std::array<VkSemaphore, MAX_FRAME_DRAWS> imageAvailable;            // Signaled by swapchain acquire (binary, required by the swapchain)
+    std::vector<VkSemaphore> renderFinished;                            // Waited by present, one per swapchain image (binary, required by the swapchain)
+    int currentFrame = 0;
+    uint64_t frameNumber = 0;           // Number of frames presented so far
+
+    // Frame capture
+    CaptureSettings captureSettings;
+    FrameCapture frameCapture;
+    std::array<CaptureSlot, CAPTURE_RING_SIZE> captureSlots;           // Readback ring, used in order
+    uint32_t nextCaptureSlot = 0;       // Slot the next captured frame is copied into
+    uint32_t oldestCaptureSlot = 0;     // Oldest slot that may still be in flight
+    bool captureMemoryCoherent = false; // Otherwise readback memory must be invalidated before the CPU reads it
+
     VkSurfaceKHR surface;
     
     VkSwapchainKHR swapchain;
     std::vector<SwapchainImage> swapchainImages;
 
+    // Pools
+    VkCommandPool graphicsCommandPool;
+    std::array<VkCommandBuffer, MAX_FRAME_DRAWS> commandBuffers;
+
     // Vulkan Utilities
     VkFormat swapchainImageFormat;
     VkExtent2D swapchainExtent;
 
+    // Dynamic resolution
+    std::array<RenderTarget, MAX_FRAME_DRAWS> renderTargets;            // One per frame in flight, allocated once at swapchain size
+    VkExtent2D renderExtent;                                            // Part of the render target the scene is rendered to this frame
+    VkRenderPass renderPass;                                            // Scene pass, its render area follows renderExtent so cost scales with it
+    std::array<VkFramebuffer, MAX_FRAME_DRAWS> renderTargetFramebuffers; // Render targets as the scene pass color attachment
+    VkFilter upscaleFilter = VK_FILTER_LINEAR;                          // Blit filter, nearest if the format cannot be filtered linearly
+    DynamicResolutionController resolutionController;
+    VkQueryPool timestampQueryPool = VK_NULL_HANDLE;                    // 2 timestamps per frame in flight (scene start, end). Null if not supported
+    std::array<bool, MAX_FRAME_DRAWS> frameTimestampsWritten = {};      // Whether the frame slot has timestamps to read back
+    float timestampPeriod = 1.0f;                                       // Nanoseconds per timestamp tick
+    uint64_t timestampMask = 0;                                         // Valid bits of a timestamp
+
     // glfw Components
     GLFWwindow* window;
+
+    // Window state, updated from the window events on the render thread
+    bool windowMinimised = false;
+
+    // Input latency: time between an event and the present of the first frame that sampled it
+    // Folded into sums as events are popped: the number of events sampled per frame is unbounded
+    std::chrono::steady_clock::time_point frameFirstEventTimestamp;     // Oldest event sampled by the frame being recorded
+    double frameEventDelayTotalMs = 0.0;                                // Sum of the time each sampled event came after the oldest one
+    uint32_t frameEventCount = 0;                                       // Events sampled by the frame being recorded
+    double inputLatencyTotalMs = 0.0;
+    double inputLatencyMaxMs = 0.0;
+    uint32_t inputLatencySampleCount = 0;
 };
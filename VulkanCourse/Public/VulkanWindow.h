@@ -1,7 +1,77 @@
 #pragma once
 
+// std
+#include <chrono>
+#include <string>
+
+// glfw
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+// src
+#include "SpscQueue.h"
+
+enum WindowEventType
+{
+    WINDOW_EVENT_KEY,
+    WINDOW_EVENT_MOUSE_BUTTON,
+    WINDOW_EVENT_CURSOR_POSITION,
+    WINDOW_EVENT_FRAMEBUFFER_RESIZE,
+    WINDOW_EVENT_ICONIFY
+};
+
+/// Input or window event, sent from the window thread to the render thread
+struct WindowEvent
+{
+    WindowEventType type = WINDOW_EVENT_KEY;
+    std::chrono::steady_clock::time_point timestamp;    // When GLFW reported the event. Used to measure input latency
+
+    int code = 0;               // Key or mouse button
+    int action = 0;             // GLFW_PRESS, GLFW_RELEASE, GLFW_REPEAT. For ICONIFY: GLFW_TRUE if iconified
+    int mods = 0;               // Modifier keys held down
+    double cursorX = 0.0;       // Cursor position, in screen coordinates
+    double cursorY = 0.0;
+    int width = 0;              // Framebuffer size, in pixels
+    int height = 0;
+};
+
+using WindowEventQueue = SpscQueue<WindowEvent, 256>;
+
 class VulkanWindow
 {
 public:
-    
+    VulkanWindow() = default;
+    ~VulkanWindow() = default;
+
+    int init(const std::string& w_name = "Vulkan Course", int width = 800, int height = 600);
+    void cleanup() const;
+
+    // Main thread only (GLFW requirement)
+    void waitEvents() const;
+    bool shouldClose() const;
+
+    // Any thread
+    void requestClose() const;
+
+    // Getters
+    GLFWwindow* getWindow() const { return window; }
+    WindowEventQueue& getEventQueue() { return eventQueue; }
+
+private:
+    // glfw callbacks, forward the events to the render thread
+    static void keyCallback(GLFWwindow* glfwWindow, int key, int scancode, int action, int mods);
+    static void mouseButtonCallback(GLFWwindow* glfwWindow, int button, int action, int mods);
+    static void cursorPositionCallback(GLFWwindow* glfwWindow, double x, double y);
+    static void framebufferSizeCallback(GLFWwindow* glfwWindow, int width, int height);
+    static void iconifyCallback(GLFWwindow* glfwWindow, int iconified);
+
+    void pushEvent(WindowEvent event);
+
+private:
+    // glfw Components
+    GLFWwindow* window = nullptr;
+
+    // Events waiting for the render thread (produced on main thread, consumed on render thread)
+    WindowEventQueue eventQueue;
+    uint32_t droppedEventCount = 0;     // Events lost because the render thread did not keep up
 };